@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+
+#include <mesh.hxx>
+
+#include <Eigen/Dense>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+
+// Writes the obj content to a temporary file and loads it back
+static std::optional<Mesh> load_obj(const std::string& filename, const std::string& content)
+{
+    const auto path = std::filesystem::temp_directory_path() / filename;
+    {
+        std::ofstream out{ path };
+        out << content;
+    }
+
+    return Mesh::load(path.string());
+}
+
+TEST_CASE("Texture coordinates are loaded from wavefront obj files", "[mesh]") {
+    const auto mesh = load_obj("tinyrenderer_test_mesh_uvs.obj",
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 0 1 0\n"
+        "v 1 1 0.5\n"
+        "vt 0 0\n"
+        "vt 1 0\n"
+        "vt 0 1\n"
+        "vt 0.25 0.75\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1\n"
+        "f 2/4/1 4/2/1 3/1/1\n"
+    );
+
+    REQUIRE(mesh);
+    REQUIRE(mesh->get_num_vertices() == 4);
+    REQUIRE(mesh->get_num_faces() == 2);
+    // y and z are flipped on load
+    REQUIRE(mesh->get_vertex(3) == Eigen::Vector3d{ 1., -1., -0.5 });
+
+    REQUIRE(mesh->has_uvs());
+    REQUIRE(mesh->get_num_uvs() == 4);
+    REQUIRE(mesh->get_uv(0) == Eigen::Vector2d{ 0., 0. });
+    REQUIRE(mesh->get_uv(3) == Eigen::Vector2d{ 0.25, 0.75 });
+
+    // Indices start at 0, and the uv indices follow the face vertices order
+    REQUIRE(mesh->get_face(0) == Eigen::Vector3i{ 0, 1, 2 });
+    REQUIRE(mesh->get_uv_face(0) == Eigen::Vector3i{ 0, 1, 2 });
+    REQUIRE(mesh->get_face(1) == Eigen::Vector3i{ 1, 3, 2 });
+    REQUIRE(mesh->get_uv_face(1) == Eigen::Vector3i{ 3, 1, 0 });
+}
+
+TEST_CASE("Meshes without vt lines have no texture coordinates", "[mesh]") {
+    // The face parser still expects v/vt/vn corners
+    const auto mesh = load_obj("tinyrenderer_test_mesh_no_uvs.obj",
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 0 1 0\n"
+        "f 1/1/1 2/1/1 3/1/1\n"
+    );
+
+    REQUIRE(mesh);
+    REQUIRE(mesh->get_num_faces() == 1);
+    REQUIRE(mesh->get_face(0) == Eigen::Vector3i{ 0, 1, 2 });
+    REQUIRE_FALSE(mesh->has_uvs());
+    REQUIRE(mesh->get_num_uvs() == 0);
+}
+
+TEST_CASE("Missing obj files are not loaded", "[mesh]") {
+    REQUIRE_FALSE(Mesh::load((std::filesystem::temp_directory_path() / "tinyrenderer_missing.obj").string()));
+}
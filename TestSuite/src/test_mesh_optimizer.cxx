@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+
+#include <mesh_optimizer.hxx>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+using tinyrenderer::compute_acmr;
+using tinyrenderer::optimize_mesh;
+
+// Grid of size x size quads, every face has its own copy of its vertices and uvs, faces are shuffled
+static Mesh make_shuffled_grid(int size)
+{
+    std::vector<Eigen::Vector3d> vertices{};
+    std::vector<Eigen::Vector2d> uvs{};
+    std::vector<Eigen::Vector3i> faces{};
+
+    auto add_vertex = [&](int x, int y)
+    {
+        vertices.emplace_back(x, y, 0.);
+        uvs.emplace_back(static_cast<double>(x) / size, static_cast<double>(y) / size);
+        return static_cast<int>(vertices.size() - 1);
+    };
+
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            faces.emplace_back(add_vertex(x, y), add_vertex(x + 1, y), add_vertex(x, y + 1));
+            faces.emplace_back(add_vertex(x + 1, y), add_vertex(x + 1, y + 1), add_vertex(x, y + 1));
+        }
+    }
+
+    std::shuffle(faces.begin(), faces.end(), std::mt19937{ 42 });
+
+    return Mesh{ vertices, faces, uvs, faces };
+}
+
+// Faces as sorted lists of their (position, uv) corners, comparable whatever the indexing
+static std::vector<std::array<double, 15>> collect_faces(const Mesh& mesh)
+{
+    std::vector<std::array<double, 15>> faces{};
+
+    for (size_t i = 0; i < mesh.get_num_faces(); ++i)
+    {
+        std::array<std::array<double, 5>, 3> corners{};
+        for (int j = 0; j < 3; ++j)
+        {
+            const auto& vertex = mesh.get_vertex(mesh.get_face(i)[j]);
+            const auto& uv = mesh.get_uv(mesh.get_uv_face(i)[j]);
+            corners[j] = { vertex.x(), vertex.y(), vertex.z(), uv.x(), uv.y() };
+        }
+
+        // Rotate the corners so that the smallest comes first, keeping the winding
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+        std::array<double, 15> face{};
+        for (int j = 0; j < 3; ++j) std::copy(corners[j].begin(), corners[j].end(), face.begin() + 5 * j);
+        faces.push_back(face);
+    }
+
+    std::sort(faces.begin(), faces.end());
+    return faces;
+}
+
+TEST_CASE("ACMR of a triangle soup is 3", "[mesh_optimizer]") {
+    const Mesh mesh = make_shuffled_grid(4);
+
+    REQUIRE(compute_acmr(mesh) == Approx(3.));
+    REQUIRE(compute_acmr(Mesh{}) == 0.);
+}
+
+TEST_CASE("ACMR counts FIFO cache hits", "[mesh_optimizer]") {
+    const std::vector<Eigen::Vector3d> vertices(5, Eigen::Vector3d::Zero());
+    const std::vector<Eigen::Vector3i> faces = { { 0, 1, 2 }, { 2, 1, 3 }, { 0, 3, 4 } };
+    const Mesh mesh{ vertices, faces };
+
+    // Large cache : only the 5 first loads miss
+    REQUIRE(compute_acmr(mesh, 16) == Approx(5. / 3.));
+    // 3 entries FIFO : loading 3 evicts 0, which misses again in the last face
+    REQUIRE(compute_acmr(mesh, 3) == Approx(6. / 3.));
+}
+
+TEST_CASE("Mesh optimization welds vertices and reduces the ACMR", "[mesh_optimizer]") {
+    const Mesh mesh = make_shuffled_grid(100);
+    auto [optimized_mesh, report] = optimize_mesh(mesh);
+
+    REQUIRE(report.vertices_before == 60000);
+    REQUIRE(report.vertices_after == 101 * 101);
+    REQUIRE(optimized_mesh.get_num_vertices() == 101 * 101);
+    REQUIRE(optimized_mesh.get_num_uvs() == 101 * 101);
+    REQUIRE(optimized_mesh.get_num_faces() == mesh.get_num_faces());
+
+    REQUIRE(report.acmr_before == Approx(3.));
+    REQUIRE(report.acmr_after == Approx(compute_acmr(optimized_mesh)));
+    REQUIRE(report.acmr_after < 0.8);
+}
+
+TEST_CASE("Mesh optimization keeps the same triangles", "[mesh_optimizer]") {
+    const Mesh mesh = make_shuffled_grid(20);
+    auto [optimized_mesh, report] = optimize_mesh(mesh);
+
+    REQUIRE(collect_faces(optimized_mesh) == collect_faces(mesh));
+}
+
+TEST_CASE("Mesh optimization orders vertices by first use", "[mesh_optimizer]") {
+    const Mesh mesh = make_shuffled_grid(20);
+    auto [optimized_mesh, report] = optimize_mesh(mesh);
+
+    int next_vertex = 0;
+    for (size_t i = 0; i < optimized_mesh.get_num_faces(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const int vertex = optimized_mesh.get_face(i)[j];
+            REQUIRE(vertex <= next_vertex);
+            if (vertex == next_vertex) ++next_vertex;
+        }
+    }
+    REQUIRE(static_cast<size_t>(next_vertex) == optimized_mesh.get_num_vertices());
+}
@@ -0,0 +1,242 @@
+#include <catch2/catch.hpp>
+
+#include <profiler.hxx>
+
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using tinyrenderer::profiling::TraceLevel;
+using tinyrenderer::profiling::TraceScope;
+using tinyrenderer::profiling::Tracer;
+
+// Minimal JSON syntax check, the cursor is moved past the parsed value
+static bool parse_json_value(std::string_view& json);
+
+static void skip_json_whitespace(std::string_view& json)
+{
+    while (!json.empty() && std::isspace(static_cast<unsigned char>(json.front()))) json.remove_prefix(1);
+}
+
+static bool parse_json_string(std::string_view& json)
+{
+    if (json.empty() || json.front() != '"') return false;
+    json.remove_prefix(1);
+
+    while (!json.empty())
+    {
+        const char c = json.front();
+        json.remove_prefix(1);
+
+        if (c == '"') return true;
+        if (static_cast<unsigned char>(c) < 0x20) return false;
+        if (c == '\\')
+        {
+            if (json.empty() || std::string_view{ "\"\\/bfnrtu" }.find(json.front()) == std::string_view::npos) return false;
+            const bool is_unicode = json.front() == 'u';
+            json.remove_prefix(1);
+
+            if (is_unicode)
+            {
+                if (json.size() < 4) return false;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    if (!std::isxdigit(static_cast<unsigned char>(json[i]))) return false;
+                }
+                json.remove_prefix(4);
+            }
+        }
+    }
+
+    return false;
+}
+
+template<class ParseElement>
+static bool parse_json_sequence(std::string_view& json, char open, char close, ParseElement parse_element)
+{
+    if (json.empty() || json.front() != open) return false;
+    json.remove_prefix(1);
+    skip_json_whitespace(json);
+
+    if (!json.empty() && json.front() == close)
+    {
+        json.remove_prefix(1);
+        return true;
+    }
+
+    while (true)
+    {
+        skip_json_whitespace(json);
+        if (!parse_element(json)) return false;
+        skip_json_whitespace(json);
+
+        if (json.empty()) return false;
+        const char c = json.front();
+        json.remove_prefix(1);
+
+        if (c == close) return true;
+        if (c != ',') return false;
+    }
+}
+
+static bool parse_json_value(std::string_view& json)
+{
+    skip_json_whitespace(json);
+    if (json.empty()) return false;
+
+    switch (json.front())
+    {
+    case '"':
+        return parse_json_string(json);
+    case '[':
+        return parse_json_sequence(json, '[', ']', parse_json_value);
+    case '{':
+        return parse_json_sequence(json, '{', '}', [](std::string_view& member)
+        {
+            if (!parse_json_string(member)) return false;
+            skip_json_whitespace(member);
+            if (member.empty() || member.front() != ':') return false;
+            member.remove_prefix(1);
+            return parse_json_value(member);
+        });
+    }
+
+    for (const std::string_view literal : { "true", "false", "null" })
+    {
+        if (json.starts_with(literal))
+        {
+            json.remove_prefix(literal.size());
+            return true;
+        }
+    }
+
+    double number{};
+    const auto [end, error] = std::from_chars(json.data(), json.data() + json.size(), number);
+    if (error != std::errc{}) return false;
+    json.remove_prefix(end - json.data());
+
+    return true;
+}
+
+static bool is_valid_json(std::string_view json)
+{
+    if (!parse_json_value(json)) return false;
+    skip_json_whitespace(json);
+
+    return json.empty();
+}
+
+// Flushes the tracer to a temporary file and reads it back
+static std::string flush_trace()
+{
+    const auto path = std::filesystem::temp_directory_path() / "tinyrenderer_test_profiler.json";
+    REQUIRE(Tracer::instance().flush(path.string()));
+
+    std::ifstream in{ path };
+    std::stringstream content{};
+    content << in.rdbuf();
+
+    return content.str();
+}
+
+// Names of the recorded events, still escaped, in the order of the trace. The tracer writes one event per line.
+static std::vector<std::string> get_event_names(const std::string& trace)
+{
+    constexpr std::string_view NAME_PREFIX = R"({"name":")";
+    constexpr std::string_view NAME_SUFFIX = R"(","cat":"tinyrenderer","ph":"X")";
+
+    std::vector<std::string> names{};
+    std::istringstream lines{ trace };
+    std::string line;
+
+    while (std::getline(lines, line))
+    {
+        const auto suffix = line.find(NAME_SUFFIX);
+        if (!line.starts_with(NAME_PREFIX) || suffix == std::string::npos) continue;
+
+        names.push_back(line.substr(NAME_PREFIX.size(), suffix - NAME_PREFIX.size()));
+    }
+
+    return names;
+}
+
+// The tracer is a singleton : tests start from emptied buffers, and record from a new thread
+// because a thread buffer keeps the size it was allocated with by the first enable()
+template<class Record>
+static std::string trace_in_new_thread(TraceLevel level, size_t events_per_thread, Record record)
+{
+    Tracer::instance().enable(level, events_per_thread);
+    flush_trace();
+
+    std::thread{ record }.join();
+
+    Tracer::instance().disable();
+    return flush_trace();
+}
+
+TEST_CASE("Ring buffers keep the newest events, oldest first", "[profiler]") {
+    static constexpr const char* NAMES[] = { "event_0", "event_1", "event_2", "event_3", "event_4", "event_5" };
+
+    const auto trace = trace_in_new_thread(TraceLevel::Frame, 4, []
+    {
+        for (const char* name : NAMES) TraceScope scope{ name };
+    });
+
+    REQUIRE(get_event_names(trace) == std::vector<std::string>{ "event_2", "event_3", "event_4", "event_5" });
+    REQUIRE(trace.find(R"("dropped_events":2})") != std::string::npos);
+    REQUIRE(is_valid_json(trace));
+
+    // The flush emptied the buffers
+    const auto next_trace = flush_trace();
+    REQUIRE(get_event_names(next_trace).empty());
+    REQUIRE(next_trace.find(R"("dropped_events":0})") != std::string::npos);
+}
+
+TEST_CASE("Scopes are only recorded up to the enabled trace level", "[profiler]") {
+    auto record = []
+    {
+        TraceScope frame_scope{ "frame" };
+        TraceScope primitive_scope{ "primitive", TraceLevel::Primitive };
+    };
+
+    // Scopes end in reverse order
+    REQUIRE(get_event_names(trace_in_new_thread(TraceLevel::Frame, 16, record)) == std::vector<std::string>{ "frame" });
+    REQUIRE(get_event_names(trace_in_new_thread(TraceLevel::Primitive, 16, record)) == std::vector<std::string>{ "primitive", "frame" });
+}
+
+TEST_CASE("Nothing is recorded while the tracer is disabled", "[profiler]") {
+    Tracer::instance().disable();
+    flush_trace();
+
+    std::thread{ [] { TraceScope scope{ "before_enable" }; } }.join();
+    Tracer::instance().enable(TraceLevel::Frame, 16);
+    std::thread{ [] { TraceScope scope{ "enabled" }; } }.join();
+    Tracer::instance().disable();
+    std::thread{ [] { TraceScope scope{ "after_disable" }; } }.join();
+
+    REQUIRE_FALSE(Tracer::is_enabled(TraceLevel::Frame));
+    REQUIRE(get_event_names(flush_trace()) == std::vector<std::string>{ "enabled" });
+}
+
+TEST_CASE("Event names are escaped in the JSON trace", "[profiler]") {
+    const auto trace = trace_in_new_thread(TraceLevel::Frame, 16, []
+    {
+        TraceScope scope{ R"(draw "mesh" \ wireframe)" };
+    });
+
+    REQUIRE(get_event_names(trace) == std::vector<std::string>{ R"(draw \"mesh\" \\ wireframe)" });
+    REQUIRE(is_valid_json(trace));
+}
+
+TEST_CASE("JSON check rejects malformed traces", "[profiler]") {
+    REQUIRE(is_valid_json(R"({"traceEvents":[{"ts":1.5,"args":{}}],"otherData":{"dropped_events":0}})"));
+    REQUIRE_FALSE(is_valid_json(R"({"traceEvents":[{"ts":1.5,}]})"));
+    REQUIRE_FALSE(is_valid_json(R"({"name":"unescaped " quote"})"));
+    REQUIRE_FALSE(is_valid_json(R"({"traceEvents":[])"));
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch.hpp>
+
+#include <rasterizer.hxx>
+
+#include <Eigen/Dense>
+
+using tinyrenderer::Rasterizer;
+
+TEST_CASE("Barycentric weights follow the vertices order", "[rasterizer]") {
+    const Eigen::Vector2i v0{ 0, 0 };
+    const Eigen::Vector2i v1{ 10, 0 };
+    const Eigen::Vector2i v2{ 0, 20 };
+
+    // Every vertex gets all the weight at its own position
+    REQUIRE(Rasterizer::compute_barycentric_coords(v0, v1, v2, v0).isApprox(Eigen::Vector3d{ 1., 0., 0. }));
+    REQUIRE(Rasterizer::compute_barycentric_coords(v0, v1, v2, v1).isApprox(Eigen::Vector3d{ 0., 1., 0. }));
+    REQUIRE(Rasterizer::compute_barycentric_coords(v0, v1, v2, v2).isApprox(Eigen::Vector3d{ 0., 0., 1. }));
+
+    // The weights interpolate the vertices back to the point
+    const Eigen::Vector2i p{ 3, 4 };
+    const auto bc = Rasterizer::compute_barycentric_coords(v0, v1, v2, p);
+    REQUIRE(bc.sum() == Approx(1.));
+    REQUIRE((v0.cast<double>() * bc.x() + v1.cast<double>() * bc.y() + v2.cast<double>() * bc.z()).isApprox(p.cast<double>()));
+
+    // Points outside of the triangle get a negative weight
+    REQUIRE(Rasterizer::compute_barycentric_coords(v0, v1, v2, { 20, 20 }).minCoeff() < 0.);
+}
+
+TEST_CASE("Degenerate triangles cover no pixel", "[rasterizer]") {
+    const Eigen::Vector2i v0{ 0, 0 };
+    const Eigen::Vector2i v1{ 5, 5 };
+    const Eigen::Vector2i v2{ 10, 10 };
+
+    REQUIRE(Rasterizer::compute_barycentric_coords(v0, v1, v2, v1).minCoeff() < 0.);
+}
@@ -0,0 +1,122 @@
+#include <catch2/catch.hpp>
+
+#include <texture.hxx>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using tinyrenderer::Texture;
+
+static std::vector<uint32_t> make_indexed_texels(uint32_t width, uint32_t height)
+{
+    std::vector<uint32_t> texels(static_cast<size_t>(width) * height);
+    for (uint32_t i = 0; i < texels.size(); ++i) texels[i] = i;
+
+    return texels;
+}
+
+// Black 24 bits BMP file
+static void write_bmp(const std::string& filename, uint32_t width, uint32_t height)
+{
+    const uint32_t row_size = (3 * width + 3) & ~3u;
+    const uint32_t image_size = row_size * height;
+
+    std::ofstream out{ filename, std::ofstream::binary };
+    auto write = [&out](uint32_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i) out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    };
+
+    out << "BM";
+    write(54 + image_size, 4);
+    write(0, 4);
+    write(54, 4);
+
+    write(40, 4);
+    write(width, 4);
+    write(height, 4);
+    write(1, 2);
+    write(24, 2);
+    write(0, 4);
+    write(image_size, 4);
+    write(2835, 4);
+    write(2835, 4);
+    write(0, 4);
+    write(0, 4);
+
+    for (uint32_t i = 0; i < image_size; ++i) out.put('\0');
+}
+
+TEST_CASE("Texels are fetched back at their position", "[texture]") {
+    // Square, non square in both directions, and non power of two levels, padded in storage
+    const auto [width, height] = GENERATE(
+        std::pair{ 8u, 8u },
+        std::pair{ 16u, 4u },
+        std::pair{ 4u, 16u },
+        std::pair{ 5u, 3u },
+        std::pair{ 1u, 7u }
+    );
+
+    const Texture texture{ width, height, make_indexed_texels(width, height) };
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            REQUIRE(texture.fetch(x, y, 0) == y * width + x);
+        }
+    }
+}
+
+TEST_CASE("Mip chain goes down to a single texel", "[texture]") {
+    REQUIRE(Texture{ 8, 8, make_indexed_texels(8, 8) }.get_num_levels() == 4);
+    REQUIRE(Texture{ 16, 4, make_indexed_texels(16, 4) }.get_num_levels() == 5);
+    REQUIRE(Texture{ 5, 3, make_indexed_texels(5, 3) }.get_num_levels() == 3);
+    REQUIRE(Texture{ 1, 1, make_indexed_texels(1, 1) }.get_num_levels() == 1);
+}
+
+TEST_CASE("Mip levels are box filtered per channel", "[texture]") {
+    const std::vector<uint32_t> texels = {
+        0xFF000000, 0xFF0000FF, 0xFF102030, 0xFF102030,
+        0xFFFF0000, 0xFF00FF00, 0xFF102030, 0xFF102030
+    };
+    const Texture texture{ 4, 2, texels };
+
+    REQUIRE(texture.get_num_levels() == 3);
+    REQUIRE(texture.fetch(0, 0, 1) == 0xFF404040);
+    REQUIRE(texture.fetch(1, 0, 1) == 0xFF102030);
+    REQUIRE(texture.fetch(0, 0, 2) == 0xFF283038);
+}
+
+TEST_CASE("Sampling wraps around and has v going upward", "[texture]") {
+    const Texture texture{ 4, 4, make_indexed_texels(4, 4) };
+
+    // Bottom left, then top right texels
+    REQUIRE(texture.sample(0.1, 0.1, 0.) == 12);
+    REQUIRE(texture.sample(0.9, 0.9, 0.) == 3);
+    REQUIRE(texture.sample(1.1, -0.9, 0.) == 12);
+
+    // Out of range lods are clamped to the existing levels
+    REQUIRE(texture.sample(0.1, 0.1, -4.) == 12);
+    REQUIRE(texture.sample(0.1, 0.1, 10.) == texture.fetch(0, 0, texture.get_num_levels() - 1));
+}
+
+TEST_CASE("Unreadable or oversized BMP files are not loaded", "[texture]") {
+    const auto directory = std::filesystem::temp_directory_path();
+
+    const auto path = (directory / "tinyrenderer_test_texture.bmp").string();
+    write_bmp(path, 3, 2);
+    const auto texture = Texture::load(path);
+    REQUIRE(texture);
+    REQUIRE(texture->get_width() == 3);
+    REQUIRE(texture->get_height() == 2);
+
+    const auto oversized_path = (directory / "tinyrenderer_test_texture_oversized.bmp").string();
+    write_bmp(oversized_path, Texture::MAX_SIZE + 1, 1);
+    REQUIRE_FALSE(Texture::load(oversized_path));
+
+    REQUIRE_FALSE(Texture::load((directory / "tinyrenderer_missing.bmp").string()));
+}
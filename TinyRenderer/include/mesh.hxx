@@ -11,6 +11,7 @@
 class Mesh
 {
 private:
+    using Vector2d = Eigen::Vector2d;
     using Vector3d = Eigen::Vector3d;
     using Vector3i = Eigen::Vector3i;
 
@@ -19,6 +20,16 @@ public:
     Mesh(const std::vector<Vector3d>& vertices, const std::vector<Vector3i>& faces)
         : vertices_{ vertices }
         , faces_{ faces }
+        , uvs_{}
+        , uv_faces_{}
+    {}
+
+    Mesh(const std::vector<Vector3d>& vertices, const std::vector<Vector3i>& faces,
+         const std::vector<Vector2d>& uvs, const std::vector<Vector3i>& uv_faces)
+        : vertices_{ vertices }
+        , faces_{ faces }
+        , uvs_{ uvs }
+        , uv_faces_{ uv_faces }
     {}
 
     Mesh(const Mesh&) = default;
@@ -31,6 +42,8 @@ public:
     {
         std::vector<Vector3d> vertices{};
         std::vector<Vector3i> faces{};
+        std::vector<Vector2d> uvs{};
+        std::vector<Vector3i> uv_faces{};
         std::ifstream in;
 
         in.open(filename, std::ifstream::in);
@@ -51,24 +64,36 @@ public:
                 for (int i = 1; i < 3; i++) v[i] = -v[i];
                 vertices.push_back(v);
             }
+            else if (!line.compare(0, 3, "vt "))
+            {
+                iss >> trash >> trash;
+                Vector2d uv;
+                for (int i = 0; i < 2; i++) iss >> uv[i];
+                uvs.push_back(uv);
+            }
             else if (!line.compare(0, 2, "f "))
             {
                 uint8_t vec_idx = 0;
                 Vector3i vec;
-                int itrash, idx;
+                Vector3i uv_vec;
+                int itrash, idx, uv_idx;
                 iss >> trash;
-                while (iss >> idx >> trash >> itrash >> trash >> itrash)
+                while (iss >> idx >> trash >> uv_idx >> trash >> itrash)
                 {
-                    idx--; // in wavefront obj all indices start at 1, not zero
-                    vec[vec_idx] = idx;
+                    // in wavefront obj all indices start at 1, not zero
+                    vec[vec_idx] = idx - 1;
+                    uv_vec[vec_idx] = uv_idx - 1;
                     vec_idx++;
                 }
                 faces.push_back(vec);
+                uv_faces.push_back(uv_vec);
             }
         }
         // std::cerr << "# v# " << verts_.size() << " f# " << faces_.size() << std::endl;
 
-        return  Mesh{ vertices, faces };
+        if (uvs.empty()) return Mesh{ vertices, faces };
+
+        return Mesh{ vertices, faces, uvs, uv_faces };
     }
 
     size_t get_num_faces() const
@@ -76,6 +101,16 @@ public:
         return faces_.size();
     }
 
+    size_t get_num_vertices() const
+    {
+        return vertices_.size();
+    }
+
+    size_t get_num_uvs() const
+    {
+        return uvs_.size();
+    }
+
     const Vector3d& get_vertex(size_t idx) const
     {
         return vertices_[idx];
@@ -86,6 +121,22 @@ public:
         return faces_[idx];
     }
 
+    bool has_uvs() const
+    {
+        return !uvs_.empty();
+    }
+
+    const Vector2d& get_uv(size_t idx) const
+    {
+        return uvs_[idx];
+    }
+
+    // Texture coordinates indices of a face, matching the vertices of get_face
+    const Vector3i& get_uv_face(size_t idx) const
+    {
+        return uv_faces_[idx];
+    }
+
     template<class Transform>
     void transform(const Transform& transform_operator)
     {
@@ -98,6 +149,8 @@ public:
 private:
     std::vector<Vector3d> vertices_;
     std::vector<Vector3i> faces_;
+    std::vector<Vector2d> uvs_;
+    std::vector<Vector3i> uv_faces_;
 };
 
 #endif // TINYRENDERER_MESH_HXX
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef TINYRENDERER_MESH_OPTIMIZER_HXX
+#define TINYRENDERER_MESH_OPTIMIZER_HXX
+
+#include <config.hxx>
+#include <mesh.hxx>
+
+#include <cstddef>
+#include <utility>
+
+namespace tinyrenderer
+{
+
+struct MeshOptimizationReport
+{
+    size_t vertices_before{};
+    size_t vertices_after{};
+    double acmr_before{};
+    double acmr_after{};
+};
+
+constexpr size_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+// Average cache miss ratio : vertices fetched per triangle through a FIFO post-transform cache of the given size.
+// Goes from 3 (no reuse at all) down to about 0.5 for a regular closed mesh.
+DLL_API double compute_acmr(const Mesh& mesh, size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Welds duplicate vertices and texture coordinates, reorders the faces for vertex reuse in a cache of
+// cache_size entries (Forsyth's linear-speed vertex cache optimization, must be larger than 3),
+// then reorders vertices and texture coordinates by first use. The report measures the ACMR with the same cache size.
+// The geometry is untouched, only the order of the faces and their vertices in memory changes.
+DLL_API std::pair<Mesh, MeshOptimizationReport> optimize_mesh(const Mesh& mesh, size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+}
+
+#endif // TINYRENDERER_MESH_OPTIMIZER_HXX
@@ -0,0 +1,141 @@
+#ifndef TINYRENDERER_PROFILER_HXX
+#define TINYRENDERER_PROFILER_HXX
+
+#include <config.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tinyrenderer::profiling
+{
+
+// Frame level scopes are a handful per frame and can stay on for minutes,
+// primitive level scopes add one event per line or triangle and fill the buffers within seconds
+enum class TraceLevel : uint8_t
+{
+    Off,
+    Frame,
+    Primitive
+};
+
+namespace details
+{
+
+// Kept out of Tracer so that scopes only pay for one load while tracing is off
+extern DLL_API std::atomic<TraceLevel> active_trace_level;
+
+}
+
+struct TraceEvent
+{
+    const char* name{};
+    int64_t start_ns{};
+    int64_t duration_ns{};
+};
+
+// Records trace scopes into fixed size per thread ring buffers and dumps them as Chrome
+// trace-event JSON (chrome://tracing, ui.perfetto.dev). A thread buffer is allocated once,
+// by enable() for the calling thread or on the first recorded scope for the others,
+// and only the most recent events are kept once it is full.
+// Event names are not copied : they must outlive the tracer (string literals).
+class DLL_API Tracer
+{
+private:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct ThreadBuffer
+    {
+        uint32_t thread_id{};
+        uint64_t recorded{};
+        std::vector<TraceEvent> events;
+    };
+
+public:
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 1 << 18;
+
+    static Tracer& instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    Tracer(Tracer&&) = delete;
+    Tracer& operator=(Tracer&&) = delete;
+
+    void enable(TraceLevel level = TraceLevel::Frame, size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+    void disable() noexcept;
+
+    static bool is_enabled(TraceLevel level = TraceLevel::Frame) noexcept
+    {
+        return details::active_trace_level.load(std::memory_order_relaxed) >= level;
+    }
+
+    void record(const char* name, TimePoint start, TimePoint end) noexcept;
+
+    // Writes every buffered event to the given file, then empties the buffers.
+    // Other recording threads must be idle while flushing (the app flushes between two frames).
+    bool flush(const std::string& filename);
+
+private:
+    Tracer() = default;
+
+    ThreadBuffer* get_thread_buffer();
+
+private:
+    size_t events_per_thread_{ DEFAULT_EVENTS_PER_THREAD };
+    TimePoint epoch_{ Clock::now() };
+    std::mutex buffers_mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+class TraceScope
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    explicit TraceScope(const char* name, TraceLevel level = TraceLevel::Frame) noexcept
+    : name_{ Tracer::is_enabled(level) ? name : nullptr }
+    , start_{ name_ != nullptr ? Clock::now() : Clock::time_point{} }
+    {}
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    TraceScope(TraceScope&&) = delete;
+    TraceScope& operator=(TraceScope&&) = delete;
+
+    ~TraceScope()
+    {
+        if (name_ != nullptr)
+        {
+            Tracer::instance().record(name_, start_, Clock::now());
+        }
+    }
+
+private:
+    const char* name_;
+    Clock::time_point start_;
+};
+
+}
+
+#define TINYRENDERER_TRACE_CONCAT_IMPL(a, b) a##b
+#define TINYRENDERER_TRACE_CONCAT(a, b) TINYRENDERER_TRACE_CONCAT_IMPL(a, b)
+
+// Tracing is compiled in but stays off until Tracer::enable() is called.
+// Define TINYRENDERER_DISABLE_TRACING to strip the scopes entirely.
+#ifndef TINYRENDERER_DISABLE_TRACING
+#define TINYRENDERER_TRACE_SCOPE(name) \
+    ::tinyrenderer::profiling::TraceScope TINYRENDERER_TRACE_CONCAT(trace_scope_, __LINE__){ name }
+#define TINYRENDERER_TRACE_PRIMITIVE_SCOPE(name) \
+    ::tinyrenderer::profiling::TraceScope TINYRENDERER_TRACE_CONCAT(trace_scope_, __LINE__){ name, ::tinyrenderer::profiling::TraceLevel::Primitive }
+#else
+#define TINYRENDERER_TRACE_SCOPE(name) ((void)0)
+#define TINYRENDERER_TRACE_PRIMITIVE_SCOPE(name) ((void)0)
+#endif
+
+#endif // TINYRENDERER_PROFILER_HXX
@@ -8,6 +8,7 @@
 
 #include <Eigen/Dense>
 
+#include <array>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -20,6 +21,8 @@ class Mesh;
 namespace tinyrenderer
 {
 
+class Texture;
+
 class DLL_API Rasterizer
 {
 private:
@@ -32,6 +35,19 @@ private:
 public:
     using RenderArea = SDL_Rect;
 
+    enum class MipSelection
+    {
+        PerTriangle,
+        PerQuad
+    };
+
+    struct TexturedVertex
+    {
+        Vector2i screen;
+        double w;
+        Vector2d uv;
+    };
+
 private:
     struct WindowDimensions
     {
@@ -39,6 +55,13 @@ private:
         uint32_t height{};
     };
 
+    // Projected vertices, with w in their z component
+    struct ProjectedFace
+    {
+        std::array<Vector3d, 3> vertices;
+        double light_intensity;
+    };
+
 public:
     Rasterizer(resource::WindowHandle&& window_handle);
     Rasterizer(const Rasterizer&) = delete;
@@ -50,11 +73,18 @@ public:
     void draw_line(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, Color color);
     void draw_triangle_sweep(Vector2i v0, Vector2i v1, Vector2i v2, Color color);
     void draw_triangle(Vector2i v0, Vector2i v1, Vector2i v2, Color color);
+    void draw_triangle(const TexturedVertex& v0, const TexturedVertex& v1, const TexturedVertex& v2, const Texture& texture, double light_intensity);
     void draw(const Mesh& mesh);
+    void draw(const Mesh& mesh, const Texture& texture);
     void draw_wireframe(const Mesh& mesh);
     void draw_overlay(const resource::SurfaceHandle& surface);
     void render();
     void render_overlay();
+    void set_camera_distance(double distance);
+    void set_mip_selection(MipSelection mip_selection);
+
+    // Weights of v0, v1 and v2 for p, degenerate triangles give a negative weight
+    static Vector3d compute_barycentric_coords(const Vector2i& v0, const Vector2i& v1, const Vector2i& v2, const Vector2i& p);
 
 private:
     void regenerate_canvas();
@@ -65,12 +95,19 @@ private:
     bool is_in_bounds(const Vector2i& pos);
     Vector2i clamp_to_canvas(const Vector2i& pos);
     uint32_t color_to_colorpoint(const Color& color);
-    Vector3d compute_barycentric_coords(const Vector2i& v0, const Vector2i& v1, const Vector2i& v2, const Vector2i& p);
     std::pair<Vector2i, Vector2i> compute_bounding_box(const Vector2i& v0, const Vector2i& v1, const Vector2i& v2);
-    Vector2i world_to_screen(const Vector3d& v);
+    std::optional<Vector2i> world_to_screen(const Vector3d& v);
+    std::optional<ProjectedFace> project_face(const Mesh& mesh, size_t face_idx);
+    Vector3d project(const Vector3d& v);
+    Vector2i projected_to_screen(const Vector3d& projected);
+    Color shade_texel(uint32_t texel, double light_intensity);
 
 private:
     static constexpr WindowDimensions MIN_WINDOW_DIM{ 50, 50 };
+    // Vertices with a smaller w are on or behind the camera plane
+    static constexpr double MIN_CLIP_W = 1e-6;
+    // Keeps far off screen coordinates representable, and their products exact in doubles
+    static constexpr double MAX_SCREEN_COORD = 1 << 20;
 
     std::vector<uint32_t> buffer_;
     resource::WindowHandle window_;
@@ -79,6 +116,8 @@ private:
     Color clear_color_;
     WindowDimensions window_dimensions_;
     resource::TextureHandle text_overlay_;
+    double camera_distance_;
+    MipSelection mip_selection_;
 };
 
 }
@@ -0,0 +1,69 @@
+#ifndef TINYRENDERER_TEXTURE_HXX
+#define TINYRENDERER_TEXTURE_HXX
+
+#include <config.hxx>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tinyrenderer
+{
+
+// ARGB8888 texture with a precomputed mip chain.
+// Each level is stored in Morton (Z-order) rather than row-major order, padded to power of two dimensions,
+// so that texels close in 2D stay close in memory whatever the direction a triangle walks the texture in.
+class DLL_API Texture
+{
+private:
+    struct MipLevel
+    {
+        uint32_t width{};
+        uint32_t height{};
+        uint32_t log2_padded_width{};
+        uint32_t log2_padded_height{};
+        size_t offset{};
+    };
+
+public:
+    // Morton indices are computed on 16 bits coordinates
+    static constexpr uint32_t MAX_SIZE = 1u << 16;
+
+    // No default constructor : a texture always has at least one level to sample from.
+    // Texels are given row-major, first row at the top of the image
+    Texture(uint32_t width, uint32_t height, const std::vector<uint32_t>& texels);
+
+    Texture(const Texture&) = default;
+    Texture& operator=(const Texture&) = default;
+    Texture(Texture&&) = default;
+    Texture& operator=(Texture&&) = default;
+    ~Texture() = default;
+
+    // Loads a BMP file, empty if it can not be read or is larger than MAX_SIZE
+    static std::optional<Texture> load(const std::string& filename);
+
+    uint32_t get_width() const noexcept;
+    uint32_t get_height() const noexcept;
+    size_t get_num_levels() const noexcept;
+
+    uint32_t fetch(uint32_t x, uint32_t y, size_t level) const;
+
+    // Nearest texel of the nearest mip level, with wrap addressing.
+    // v goes upward as in wavefront obj, lod is the log2 of the texel footprint of a pixel.
+    uint32_t sample(double u, double v, double lod) const;
+
+private:
+    void generate_mip_chain(const std::vector<uint32_t>& texels);
+    size_t texel_index(const MipLevel& level, uint32_t x, uint32_t y) const noexcept;
+
+    static uint32_t morton_encode(uint32_t x, uint32_t y) noexcept;
+
+private:
+    std::vector<MipLevel> levels_;
+    std::vector<uint32_t> texels_;
+};
+
+}
+
+#endif // TINYRENDERER_TEXTURE_HXX
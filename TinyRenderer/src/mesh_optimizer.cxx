@@ -0,0 +1,301 @@
+#include <mesh_optimizer.hxx>
+
+#include <snowhouse/snowhouse.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace tinyrenderer
+{
+
+using Vector2d = Eigen::Vector2d;
+using Vector3d = Eigen::Vector3d;
+using Vector3i = Eigen::Vector3i;
+
+// Only exactly equal values are merged, so the geometry is left untouched
+template<class Vector>
+static std::vector<int32_t> weld(const std::vector<Vector>& values, std::vector<Vector>& welded_values)
+{
+    auto less = [](const Vector& lhs, const Vector& rhs)
+    {
+        for (Eigen::Index i = 0; i < lhs.size(); ++i)
+        {
+            if (lhs[i] != rhs[i]) return lhs[i] < rhs[i];
+        }
+        return false;
+    };
+
+    std::map<Vector, int32_t, decltype(less)> unique_values{ less };
+    std::vector<int32_t> remap(values.size());
+
+    welded_values.clear();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        auto [it, inserted] = unique_values.try_emplace(values[i], static_cast<int32_t>(welded_values.size()));
+        if (inserted) welded_values.push_back(values[i]);
+        remap[i] = it->second;
+    }
+
+    return remap;
+}
+
+static double forsyth_vertex_score(int32_t cache_position, uint32_t remaining_faces, size_t cache_size)
+{
+    constexpr double CACHE_DECAY_POWER = 1.5;
+    constexpr double LAST_FACE_SCORE = 0.75;
+    constexpr double VALENCE_BOOST_SCALE = 2.;
+    constexpr double VALENCE_BOOST_POWER = 0.5;
+
+    if (remaining_faces == 0) return -1.;
+
+    double score = 0.;
+    if (cache_position >= 0)
+    {
+        // The vertices of the last face get a fixed score, so that the next face does not always reuse the same edge
+        if (cache_position < 3)
+        {
+            score = LAST_FACE_SCORE;
+        }
+        else
+        {
+            const double scaler = 1. / (cache_size - 3);
+            score = std::pow(1. - (cache_position - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favor vertices with few faces left, so that they do not end up as lone faces at the end
+    return score + VALENCE_BOOST_SCALE * std::pow(static_cast<double>(remaining_faces), -VALENCE_BOOST_POWER);
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation" : greedily emit the face with the highest score,
+// only rescoring the faces around the vertices of the simulated cache.
+static std::vector<size_t> forsyth_face_order(const std::vector<Vector3i>& faces, size_t num_vertices, size_t cache_size)
+{
+    const size_t num_faces = faces.size();
+
+    // Faces around each vertex, the remaining ones are kept at the front of each range
+    std::vector<uint32_t> adjacency_offsets(num_vertices + 1, 0);
+    for (const auto& face : faces)
+    {
+        for (int j = 0; j < 3; ++j) ++adjacency_offsets[face[j] + 1];
+    }
+    std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+
+    std::vector<uint32_t> adjacency(num_faces * 3);
+    std::vector<uint32_t> remaining_faces(num_vertices, 0);
+    for (size_t i = 0; i < num_faces; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const auto v = faces[i][j];
+            adjacency[adjacency_offsets[v] + remaining_faces[v]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    std::vector<int32_t> cache_positions(num_vertices, -1);
+    std::vector<double> vertex_scores(num_vertices);
+    for (size_t v = 0; v < num_vertices; ++v)
+    {
+        vertex_scores[v] = forsyth_vertex_score(-1, remaining_faces[v], cache_size);
+    }
+
+    auto face_score = [&](size_t face_idx)
+    {
+        const auto& face = faces[face_idx];
+        return vertex_scores[face[0]] + vertex_scores[face[1]] + vertex_scores[face[2]];
+    };
+
+    std::vector<double> face_scores(num_faces);
+    for (size_t i = 0; i < num_faces; ++i) face_scores[i] = face_score(i);
+
+    std::vector<bool> emitted(num_faces, false);
+    std::vector<uint32_t> cache{};
+    std::vector<uint32_t> next_cache{};
+    std::vector<size_t> order{};
+    order.reserve(num_faces);
+
+    size_t best_face = std::distance(face_scores.begin(), std::max_element(face_scores.begin(), face_scores.end()));
+    size_t next_unemitted = 0;
+
+    while (order.size() < num_faces)
+    {
+        // Nothing left around the cache, restart from any face
+        if (best_face == num_faces)
+        {
+            while (emitted[next_unemitted]) ++next_unemitted;
+            best_face = next_unemitted;
+        }
+
+        emitted[best_face] = true;
+        order.push_back(best_face);
+
+        const auto& face = faces[best_face];
+        next_cache.clear();
+        for (int j = 0; j < 3; ++j)
+        {
+            const auto v = face[j];
+            const auto begin = adjacency.begin() + adjacency_offsets[v];
+            const auto end = begin + remaining_faces[v];
+            *std::find(begin, end, static_cast<uint32_t>(best_face)) = *(end - 1);
+            --remaining_faces[v];
+
+            if (std::find(next_cache.begin(), next_cache.end(), static_cast<uint32_t>(v)) == next_cache.end())
+            {
+                next_cache.push_back(v);
+            }
+        }
+
+        const size_t num_face_vertices = next_cache.size();
+        for (auto v : cache)
+        {
+            if (std::find(next_cache.begin(), next_cache.begin() + num_face_vertices, v) == next_cache.begin() + num_face_vertices)
+            {
+                next_cache.push_back(v);
+            }
+        }
+
+        // Evicted vertices are kept past the end of the cache until their faces are rescored
+        for (size_t i = 0; i < next_cache.size(); ++i)
+        {
+            const auto v = next_cache[i];
+            cache_positions[v] = i < cache_size ? static_cast<int32_t>(i) : -1;
+            vertex_scores[v] = forsyth_vertex_score(cache_positions[v], remaining_faces[v], cache_size);
+        }
+
+        best_face = num_faces;
+        double best_score = -1.;
+        for (auto v : next_cache)
+        {
+            const auto begin = adjacency.begin() + adjacency_offsets[v];
+            for (auto it = begin; it != begin + remaining_faces[v]; ++it)
+            {
+                face_scores[*it] = face_score(*it);
+                if (face_scores[*it] > best_score)
+                {
+                    best_score = face_scores[*it];
+                    best_face = *it;
+                }
+            }
+        }
+
+        next_cache.resize(std::min(next_cache.size(), cache_size));
+        std::swap(cache, next_cache);
+    }
+
+    return order;
+}
+
+// Renumbers the indices of the faces by order of first use, and moves the values accordingly
+template<class Vector>
+static std::vector<Vector> reorder_by_first_use(const std::vector<Vector>& values, std::vector<Vector3i>& faces)
+{
+    std::vector<int32_t> remap(values.size(), -1);
+    std::vector<Vector> reordered_values{};
+    reordered_values.reserve(values.size());
+
+    for (auto& face : faces)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            if (remap[face[j]] < 0)
+            {
+                remap[face[j]] = static_cast<int32_t>(reordered_values.size());
+                reordered_values.push_back(values[face[j]]);
+            }
+            face[j] = remap[face[j]];
+        }
+    }
+
+    return reordered_values;
+}
+
+double compute_acmr(const Mesh& mesh, size_t cache_size)
+{
+    if (mesh.get_num_faces() == 0) return 0.;
+
+    // A vertex stays in the FIFO until cache_size other vertices have been loaded after it
+    std::vector<size_t> loaded_at(mesh.get_num_vertices(), 0);
+    size_t misses = 0;
+
+    for (size_t i = 0; i < mesh.get_num_faces(); ++i)
+    {
+        const auto& face = mesh.get_face(i);
+        for (int j = 0; j < 3; ++j)
+        {
+            const auto v = face[j];
+            if (loaded_at[v] == 0 || misses - loaded_at[v] >= cache_size)
+            {
+                ++misses;
+                loaded_at[v] = misses;
+            }
+        }
+    }
+
+    return static_cast<double>(misses) / mesh.get_num_faces();
+}
+
+std::pair<Mesh, MeshOptimizationReport> optimize_mesh(const Mesh& mesh, size_t cache_size)
+{
+    using snowhouse::IsGreaterThan;
+
+    // The last face vertices get a fixed score, the cache has to hold more than them
+    AssertThat(cache_size, IsGreaterThan(size_t{ 3 }));
+
+    std::vector<Vector3d> vertices(mesh.get_num_vertices());
+    for (size_t i = 0; i < vertices.size(); ++i) vertices[i] = mesh.get_vertex(i);
+
+    std::vector<Vector3i> faces(mesh.get_num_faces());
+    for (size_t i = 0; i < faces.size(); ++i) faces[i] = mesh.get_face(i);
+
+    std::vector<Vector2d> uvs(mesh.get_num_uvs());
+    for (size_t i = 0; i < uvs.size(); ++i) uvs[i] = mesh.get_uv(i);
+
+    std::vector<Vector3i> uv_faces(mesh.has_uvs() ? faces.size() : 0);
+    for (size_t i = 0; i < uv_faces.size(); ++i) uv_faces[i] = mesh.get_uv_face(i);
+
+    std::vector<Vector3d> welded_vertices{};
+    const auto vertex_remap = weld(vertices, welded_vertices);
+    for (auto& face : faces)
+    {
+        for (int j = 0; j < 3; ++j) face[j] = vertex_remap[face[j]];
+    }
+
+    std::vector<Vector2d> welded_uvs{};
+    const auto uv_remap = weld(uvs, welded_uvs);
+    for (auto& uv_face : uv_faces)
+    {
+        for (int j = 0; j < 3; ++j) uv_face[j] = uv_remap[uv_face[j]];
+    }
+
+    const auto face_order = forsyth_face_order(faces, welded_vertices.size(), cache_size);
+
+    std::vector<Vector3i> ordered_faces(faces.size());
+    std::vector<Vector3i> ordered_uv_faces(uv_faces.size());
+    for (size_t i = 0; i < face_order.size(); ++i)
+    {
+        ordered_faces[i] = faces[face_order[i]];
+        if (!uv_faces.empty()) ordered_uv_faces[i] = uv_faces[face_order[i]];
+    }
+
+    auto ordered_vertices = reorder_by_first_use(welded_vertices, ordered_faces);
+    auto ordered_uvs = reorder_by_first_use(welded_uvs, ordered_uv_faces);
+
+    Mesh optimized_mesh = mesh.has_uvs()
+        ? Mesh{ ordered_vertices, ordered_faces, ordered_uvs, ordered_uv_faces }
+        : Mesh{ ordered_vertices, ordered_faces };
+
+    MeshOptimizationReport report{
+        mesh.get_num_vertices(),
+        optimized_mesh.get_num_vertices(),
+        compute_acmr(mesh, cache_size),
+        compute_acmr(optimized_mesh, cache_size)
+    };
+
+    return { std::move(optimized_mesh), report };
+}
+
+}
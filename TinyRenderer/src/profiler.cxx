@@ -0,0 +1,124 @@
+#include <profiler.hxx>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace tinyrenderer::profiling
+{
+
+std::atomic<TraceLevel> details::active_trace_level{ TraceLevel::Off };
+
+static void write_escaped(std::ofstream& out, const char* str)
+{
+    for (; *str != '\0'; ++str)
+    {
+        if (*str == '"' || *str == '\\') out << '\\';
+        out << *str;
+    }
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer{};
+    return tracer;
+}
+
+void Tracer::enable(TraceLevel level, size_t events_per_thread)
+{
+    {
+        std::lock_guard lock{ buffers_mutex_ };
+        events_per_thread_ = std::max<size_t>(events_per_thread, 1);
+    }
+
+    // Allocate the calling thread buffer now rather than in the middle of a frame
+    get_thread_buffer();
+    details::active_trace_level.store(level, std::memory_order_relaxed);
+}
+
+void Tracer::disable() noexcept
+{
+    details::active_trace_level.store(TraceLevel::Off, std::memory_order_relaxed);
+}
+
+void Tracer::record(const char* name, TimePoint start, TimePoint end) noexcept
+{
+    ThreadBuffer* buffer = get_thread_buffer();
+    if (buffer == nullptr) return;
+
+    auto& event = buffer->events[buffer->recorded % buffer->events.size()];
+    event.name = name;
+    event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count();
+    event.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    ++buffer->recorded;
+}
+
+bool Tracer::flush(const std::string& filename)
+{
+    std::ofstream out{ filename, std::ofstream::out | std::ofstream::trunc };
+    if (out.fail()) return false;
+
+    std::lock_guard lock{ buffers_mutex_ };
+
+    uint64_t dropped_events = 0;
+    bool first = true;
+
+    // Chrome expects microseconds, keep the nanoseconds as decimals
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    for (auto& buffer : buffers_)
+    {
+        out << (first ? "" : ",") << '\n'
+            << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->thread_id
+            << R"(,"args":{"name":"thread )" << buffer->thread_id << R"("}})";
+        first = false;
+
+        const uint64_t capacity = buffer->events.size();
+        const uint64_t kept = std::min(buffer->recorded, capacity);
+        dropped_events += buffer->recorded - kept;
+
+        // Oldest surviving event first, the ring buffer may have wrapped around
+        for (uint64_t i = buffer->recorded - kept; i < buffer->recorded; ++i)
+        {
+            const auto& event = buffer->events[i % capacity];
+
+            out << ",\n{\"name\":\"";
+            write_escaped(out, event.name);
+            out << R"(","cat":"tinyrenderer","ph":"X","pid":1,"tid":)" << buffer->thread_id
+                << R"(,"ts":)" << event.start_ns / 1000.
+                << R"(,"dur":)" << event.duration_ns / 1000. << '}';
+        }
+
+        buffer->recorded = 0;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped_events << "}}\n";
+
+    return !out.fail();
+}
+
+auto Tracer::get_thread_buffer()
+-> ThreadBuffer*
+{
+    thread_local ThreadBuffer* thread_buffer = nullptr;
+
+    if (thread_buffer == nullptr)
+    {
+        try
+        {
+            std::lock_guard lock{ buffers_mutex_ };
+
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->thread_id = static_cast<uint32_t>(buffers_.size() + 1);
+            buffer->events.resize(events_per_thread_);
+            thread_buffer = buffers_.emplace_back(std::move(buffer)).get();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    return thread_buffer;
+}
+
+}
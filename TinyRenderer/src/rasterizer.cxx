@@ -1,12 +1,16 @@
 #include <rasterizer.hxx>
 
 #include <mesh.hxx>
+#include <profiler.hxx>
+#include <texture.hxx>
 
 #include <snowhouse/snowhouse.h>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 void test_line(SDL_Texture* screen_texture, size_t width, size_t height)
@@ -41,7 +45,11 @@ Rasterizer::Rasterizer(resource::WindowHandle&& window_handle)
 , clear_color_{ 0, 0, 0, 0 }
 , window_dimensions_{}
 , text_overlay_{}
+, camera_distance_{ std::numeric_limits<double>::infinity() }
+, mip_selection_{ MipSelection::PerQuad }
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::Rasterizer");
+
     using snowhouse::IsNull;
 
     int window_width{};
@@ -63,14 +71,35 @@ Rasterizer::Rasterizer(resource::WindowHandle&& window_handle)
 
 void Rasterizer::resize_canvas(uint32_t width, uint32_t height)
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::resize_canvas");
+
     window_dimensions_.width = width;
     window_dimensions_.height = height;
 
     regenerate_canvas();
 }
 
+void Rasterizer::set_camera_distance(double distance)
+{
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::set_camera_distance");
+
+    using snowhouse::IsGreaterThan;
+
+    AssertThat(distance, IsGreaterThan(0.));
+    camera_distance_ = distance;
+}
+
+void Rasterizer::set_mip_selection(MipSelection mip_selection)
+{
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::set_mip_selection");
+
+    mip_selection_ = mip_selection;
+}
+
 void Rasterizer::render()
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::render");
+
     SDL_RenderClear(render_.get());
     SDL_UpdateTexture(canvas_.get(), nullptr, buffer_.data(), static_cast<uint32_t>(window_dimensions_.width) * sizeof(uint32_t));
     SDL_RenderCopy(render_.get(), canvas_.get(), nullptr, nullptr);
@@ -81,6 +110,8 @@ void Rasterizer::render()
 
 void Rasterizer::render_overlay()
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::render_overlay");
+
     int w, h;
     SDL_QueryTexture(text_overlay_.get(), nullptr, nullptr, &w, &h);
     RenderArea render_area{0, 0, w, h };
@@ -91,6 +122,8 @@ void Rasterizer::render_overlay()
 
 void Rasterizer::draw_line(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, Color color)
 {
+    TINYRENDERER_TRACE_PRIMITIVE_SCOPE("Rasterizer::draw_line");
+
     bool steep = false;
 
     if (!is_in_bounds(x0, y0) && !is_in_bounds(x1, y1)) return;
@@ -162,6 +195,8 @@ static int32_t linear_interpolation(int32_t a, int32_t b, double alpha)
 // Line sweep triangle algorithm
 void Rasterizer::draw_triangle_sweep(Vector2i v0, Vector2i v1, Vector2i v2, Color color)
 {
+    TINYRENDERER_TRACE_PRIMITIVE_SCOPE("Rasterizer::draw_triangle_sweep");
+
     if (!(is_in_bounds(v0) || is_in_bounds(v1) || is_in_bounds(v2))) return;
 
     std::array<Vector2i, 3> vertices = { 
@@ -217,7 +252,7 @@ auto Rasterizer::compute_barycentric_coords(const Vector2i& v0, const Vector2i&
     // Handle degenerate case
     if (std::abs(u.z()) < 1) return Vector3d{ -1, 1, 1 };
 
-    return Vector3d{ 1 - (u.x() + u.y()) / u.z(), u.y() / u.z(), u.x() / u.z() };
+    return Vector3d{ 1 - (u.x() + u.y()) / u.z(), u.x() / u.z(), u.y() / u.z() };
 }
 
 auto Rasterizer::compute_bounding_box(const Vector2i& v0, const Vector2i& v1, const Vector2i& v2)
@@ -237,6 +272,8 @@ auto Rasterizer::compute_bounding_box(const Vector2i& v0, const Vector2i& v1, co
 // Draw triangles based on barycentric coordinates
 void Rasterizer::draw_triangle(Vector2i v0, Vector2i v1, Vector2i v2, Color color)
 {
+    TINYRENDERER_TRACE_PRIMITIVE_SCOPE("Rasterizer::draw_triangle");
+
     auto [bounding_box_min, bounding_box_max] = compute_bounding_box(v0, v1, v2);
 
     for (int32_t x = bounding_box_min.x(); x <= bounding_box_max.x(); ++x)
@@ -253,6 +290,88 @@ void Rasterizer::draw_triangle(Vector2i v0, Vector2i v1, Vector2i v2, Color colo
     }
 }
 
+// Textured triangles are walked by 2x2 pixel quads, like GPUs do, so that the per quad mip selection
+// can use the uv differences between neighbouring pixels, covered or not, as screen space derivatives
+void Rasterizer::draw_triangle(const TexturedVertex& v0, const TexturedVertex& v1, const TexturedVertex& v2, const Texture& texture, double light_intensity)
+{
+    TINYRENDERER_TRACE_PRIMITIVE_SCOPE("Rasterizer::draw_triangle(textured)");
+
+    auto [bounding_box_min, bounding_box_max] = compute_bounding_box(v0.screen, v1.screen, v2.screen);
+    const Vector2d texture_size{ texture.get_width(), texture.get_height() };
+
+    // Perspective correct interpolation : uv / w and 1 / w are affine in screen space, uv is not
+    auto interpolate_uv = [&](const Vector3d& bc) -> Vector2d
+    {
+        const Vector3d perspective_bc{ bc.x() / v0.w, bc.y() / v1.w, bc.z() / v2.w };
+        const double inv_w = perspective_bc.sum();
+
+        // Helper pixels far outside of the triangle may end up behind the camera
+        if (inv_w <= 0) return v0.uv * bc.x() + v1.uv * bc.y() + v2.uv * bc.z();
+
+        return (v0.uv * perspective_bc.x() + v1.uv * perspective_bc.y() + v2.uv * perspective_bc.z()) / inv_w;
+    };
+
+    double triangle_lod = 0;
+    if (mip_selection_ == MipSelection::PerTriangle)
+    {
+        const Vector2d s1 = (v1.screen - v0.screen).cast<double>();
+        const Vector2d s2 = (v2.screen - v0.screen).cast<double>();
+        const Vector2d t1 = (v1.uv - v0.uv).cwiseProduct(texture_size);
+        const Vector2d t2 = (v2.uv - v0.uv).cwiseProduct(texture_size);
+
+        const double pixel_area = std::abs(s1.x() * s2.y() - s1.y() * s2.x());
+        const double texel_area = std::abs(t1.x() * t2.y() - t1.y() * t2.x());
+
+        if (pixel_area > 0) triangle_lod = 0.5 * std::log2(texel_area / pixel_area);
+    }
+
+    // Quads are aligned on even coordinates, so that neighbouring triangles agree on them
+    const int32_t min_x = std::max(0, bounding_box_min.x()) & ~1;
+    const int32_t min_y = std::max(0, bounding_box_min.y()) & ~1;
+
+    for (int32_t y = min_y; y <= bounding_box_max.y(); y += 2)
+    {
+        for (int32_t x = min_x; x <= bounding_box_max.x(); x += 2)
+        {
+            std::array<Vector2i, 4> pixels{};
+            std::array<Vector3d, 4> bcs{};
+            std::array<bool, 4> covered{};
+            bool is_quad_covered = false;
+
+            for (size_t q = 0; q < 4; ++q)
+            {
+                pixels[q] = Vector2i{ x + static_cast<int32_t>(q & 1), y + static_cast<int32_t>(q >> 1) };
+                bcs[q] = compute_barycentric_coords(v0.screen, v1.screen, v2.screen, pixels[q]);
+                covered[q] = bcs[q].x() >= 0 && bcs[q].y() >= 0 && bcs[q].z() >= 0
+                    && pixels[q].x() <= bounding_box_max.x() && pixels[q].y() <= bounding_box_max.y();
+                is_quad_covered |= covered[q];
+            }
+
+            if (!is_quad_covered) continue;
+
+            std::array<Vector2d, 4> uvs{};
+            for (size_t q = 0; q < 4; ++q) uvs[q] = interpolate_uv(bcs[q]);
+
+            double lod = triangle_lod;
+            if (mip_selection_ == MipSelection::PerQuad)
+            {
+                const Vector2d duv_dx = (uvs[1] - uvs[0]).cwiseProduct(texture_size);
+                const Vector2d duv_dy = (uvs[2] - uvs[0]).cwiseProduct(texture_size);
+
+                lod = 0.5 * std::log2(std::max(duv_dx.squaredNorm(), duv_dy.squaredNorm()));
+            }
+
+            for (size_t q = 0; q < 4; ++q)
+            {
+                if (!covered[q]) continue;
+
+                const auto texel = texture.sample(uvs[q].x(), uvs[q].y(), lod);
+                canvas_set(pixels[q].x(), pixels[q].y(), shade_texel(texel, light_intensity));
+            }
+        }
+    }
+}
+
 // Failed attempt, using a line sweep from the "top vertex"
 // Unfortunately, it produces artefacts
 /* void Rasterizer::draw_triangle(Vector2i v0, Vector2i v1, Vector2i v2, Color color)
@@ -336,32 +455,50 @@ void Rasterizer::draw_triangle(Vector2i v0, Vector2i v1, Vector2i v2, Color colo
 
 void Rasterizer::draw(const Mesh& mesh)
 {
-    Vector3d light_dir = Vector3d::UnitZ();
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::draw");
 
     for (int i = 0; i < mesh.get_num_faces(); ++i)
     {
-        Vector3i face = mesh.get_face(i);
-        Vector3d normal = (mesh.get_vertex(face[2]) - mesh.get_vertex(face[0])).cross(mesh.get_vertex(face[1]) - mesh.get_vertex(face[0]));
-        normal.normalize();
-        auto light_intensity = normal.dot(light_dir);
+        const auto projected_face = project_face(mesh, i);
+        if (!projected_face) continue;
 
-        if (light_intensity > 0)
-        {
-            std::array<Vector2i, 3> screen_coords{};
-            for (int j = 0; j < screen_coords.size(); ++j)
-            {
-                const auto& vertex = mesh.get_vertex(face[j]);
-                screen_coords[j] = world_to_screen(vertex);
-            }
+        const auto& [vertices, light_intensity] = *projected_face;
+        Color color = { static_cast<uint8_t>(light_intensity * 255), static_cast<uint8_t>(light_intensity * 255), static_cast<uint8_t>(light_intensity * 255) };
+        draw_triangle(projected_to_screen(vertices[0]), projected_to_screen(vertices[1]), projected_to_screen(vertices[2]), color);
+    }
+}
+
+void Rasterizer::draw(const Mesh& mesh, const Texture& texture)
+{
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::draw(textured)");
+
+    if (!mesh.has_uvs())
+    {
+        draw(mesh);
+        return;
+    }
 
-            Color color = { static_cast<uint8_t>(light_intensity * 255), static_cast<uint8_t>(light_intensity * 255), static_cast<uint8_t>(light_intensity * 255) };
-            draw_triangle(screen_coords[0], screen_coords[1], screen_coords[2], color);
+    for (int i = 0; i < mesh.get_num_faces(); ++i)
+    {
+        const auto projected_face = project_face(mesh, i);
+        if (!projected_face) continue;
+
+        const Vector3i& uv_face = mesh.get_uv_face(i);
+        std::array<TexturedVertex, 3> vertices{};
+        for (int j = 0; j < vertices.size(); ++j)
+        {
+            const auto& projected = projected_face->vertices[j];
+            vertices[j] = { projected_to_screen(projected), projected.z(), mesh.get_uv(uv_face[j]) };
         }
+
+        draw_triangle(vertices[0], vertices[1], vertices[2], texture, projected_face->light_intensity);
     }
 }
 
 void Rasterizer::draw_wireframe(const Mesh& mesh)
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::draw_wireframe");
+
     for (int i = 0; i < mesh.get_num_faces(); ++i) 
     {
         Vector3i face = mesh.get_face(i);
@@ -373,18 +510,24 @@ void Rasterizer::draw_wireframe(const Mesh& mesh)
 
             auto sv0 = world_to_screen(wv0);
             auto sv1 = world_to_screen(wv1);
-            draw_line(sv0.x(), sv0.y(), sv1.x(), sv1.y(), Color{0, 255, 0});
+            if (!sv0 || !sv1) continue;
+
+            draw_line(sv0->x(), sv0->y(), sv1->x(), sv1->y(), Color{0, 255, 0});
         }
     }
 }
 
 void Rasterizer::draw_overlay(const resource::SurfaceHandle& surface)
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::draw_overlay");
+
     text_overlay_ = SDL_CreateTextureFromSurface(render_.get(), surface.get());
 }
 
 void Rasterizer::regenerate_canvas()
 {
+    TINYRENDERER_TRACE_SCOPE("Rasterizer::regenerate_canvas");
+
     using snowhouse::IsNull;
 
     canvas_ = SDL_CreateTexture(render_.get(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, window_dimensions_.width, window_dimensions_.height);
@@ -419,13 +562,78 @@ auto Rasterizer::clamp_to_canvas(const Vector2i& pos)
     };
 }
 
-// For now, we assume that the "world" coordinate is the clip coordinate ([-1, 1], disregarding the z component)
+// Projects a face for the filled draws, empty when it is turned away from the camera or crosses the camera plane.
+// Back faces are culled from the winding of the projected triangle, which holds for any camera distance,
+// the light direction only gives the shading.
+auto Rasterizer::project_face(const Mesh& mesh, size_t face_idx)
+-> std::optional<ProjectedFace>
+{
+    const Vector3d light_dir = Vector3d::UnitZ();
+    const Vector3i& face = mesh.get_face(face_idx);
+
+    ProjectedFace projected_face{};
+    for (int j = 0; j < 3; ++j)
+    {
+        projected_face.vertices[j] = project(mesh.get_vertex(face[j]));
+
+        // No clipping yet, faces crossing the camera plane are dropped
+        if (projected_face.vertices[j].z() < MIN_CLIP_W) return {};
+    }
+
+    // Same orientation as the normal below, positive when the face is toward the camera
+    const Vector2d e1 = (projected_face.vertices[1] - projected_face.vertices[0]).head<2>();
+    const Vector2d e2 = (projected_face.vertices[2] - projected_face.vertices[0]).head<2>();
+    if (e2.x() * e1.y() - e2.y() * e1.x() <= 0) return {};
+
+    Vector3d normal = (mesh.get_vertex(face[2]) - mesh.get_vertex(face[0])).cross(mesh.get_vertex(face[1]) - mesh.get_vertex(face[0]));
+    normal.normalize();
+    projected_face.light_intensity = std::max(normal.dot(light_dir), 0.);
+
+    return projected_face;
+}
+
+// For now, we assume that the "world" coordinate is the clip coordinate ([-1, 1])
+// Empty for vertices on or behind the camera plane
 auto Rasterizer::world_to_screen(const Vector3d& v)
+-> std::optional<Vector2i>
+{
+    const auto projected = project(v);
+    if (projected.z() < MIN_CLIP_W) return {};
+
+    return projected_to_screen(projected);
+}
+
+auto Rasterizer::projected_to_screen(const Vector3d& projected)
 -> Vector2i
 {
     return {
-        static_cast<uint32_t>((v(0) + 1.) * window_dimensions_.width / 2.),
-        static_cast<uint32_t>((v(1) + 1.) * window_dimensions_.height / 2.)
+        static_cast<int32_t>(std::clamp(projected.x(), -MAX_SCREEN_COORD, MAX_SCREEN_COORD)),
+        static_cast<int32_t>(std::clamp(projected.y(), -MAX_SCREEN_COORD, MAX_SCREEN_COORD))
+    };
+}
+
+// Central projection from a camera on the z axis, looking toward the origin.
+// Returns the screen coordinates, and the w divisor in the z component.
+// The default infinite camera distance gives back an orthographic projection (w = 1).
+auto Rasterizer::project(const Vector3d& v)
+-> Vector3d
+{
+    const double w = 1. - v.z() / camera_distance_;
+
+    return {
+        (v.x() / w + 1.) * window_dimensions_.width / 2.,
+        (v.y() / w + 1.) * window_dimensions_.height / 2.,
+        w
+    };
+}
+
+auto Rasterizer::shade_texel(uint32_t texel, double light_intensity)
+-> Color
+{
+    return {
+        static_cast<uint8_t>(((texel >> 16) & 0xFF) * light_intensity),
+        static_cast<uint8_t>(((texel >> 8) & 0xFF) * light_intensity),
+        static_cast<uint8_t>((texel & 0xFF) * light_intensity)
     };
 }
 
@@ -0,0 +1,190 @@
+#include <texture.hxx>
+
+#include <resource_handler.hxx>
+
+#include <snowhouse/snowhouse.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace tinyrenderer
+{
+
+static uint32_t log2_ceil(uint32_t n)
+{
+    return static_cast<uint32_t>(std::bit_width(std::max(n, 1u) - 1));
+}
+
+static uint32_t average_texels(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3)
+{
+    uint32_t result = 0;
+
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        const uint32_t sum = ((t0 >> shift) & 0xFF) + ((t1 >> shift) & 0xFF) + ((t2 >> shift) & 0xFF) + ((t3 >> shift) & 0xFF);
+        result |= ((sum + 2) / 4) << shift;
+    }
+
+    return result;
+}
+
+Texture::Texture(uint32_t width, uint32_t height, const std::vector<uint32_t>& texels)
+: levels_{}
+, texels_{}
+{
+    using snowhouse::Equals;
+    using snowhouse::IsGreaterThan;
+    using snowhouse::IsLessThanOrEqualTo;
+
+    AssertThat(width, IsGreaterThan(0u));
+    AssertThat(height, IsGreaterThan(0u));
+    AssertThat(std::max(width, height), IsLessThanOrEqualTo(MAX_SIZE));
+    AssertThat(texels.size(), Equals(static_cast<size_t>(width) * height));
+
+    size_t total_size = 0;
+    uint32_t level_width = width;
+    uint32_t level_height = height;
+
+    while (true)
+    {
+        MipLevel level{ level_width, level_height, log2_ceil(level_width), log2_ceil(level_height), total_size };
+        total_size += size_t{ 1 } << (level.log2_padded_width + level.log2_padded_height);
+        levels_.push_back(level);
+
+        if (level_width == 1 && level_height == 1) break;
+        level_width = std::max(level_width / 2, 1u);
+        level_height = std::max(level_height / 2, 1u);
+    }
+
+    texels_.resize(total_size);
+    generate_mip_chain(texels);
+}
+
+std::optional<Texture> Texture::load(const std::string& filename)
+{
+    resource::SurfaceHandle bmp_surface{ SDL_LoadBMP(filename.c_str()) };
+    if (bmp_surface.get() == nullptr) return {};
+
+    resource::SurfaceHandle surface{ SDL_ConvertSurfaceFormat(bmp_surface.get(), SDL_PIXELFORMAT_ARGB8888, 0) };
+    if (surface.get() == nullptr || surface.get()->w <= 0 || surface.get()->h <= 0) return {};
+
+    const auto width = static_cast<uint32_t>(surface.get()->w);
+    const auto height = static_cast<uint32_t>(surface.get()->h);
+    if (std::max(width, height) > MAX_SIZE) return {};
+
+    std::vector<uint32_t> texels(static_cast<size_t>(width) * height);
+
+    if (SDL_LockSurface(surface.get()) != 0) return {};
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const auto* row = static_cast<const uint8_t*>(surface.get()->pixels) + static_cast<size_t>(y) * surface.get()->pitch;
+        std::memcpy(texels.data() + static_cast<size_t>(y) * width, row, width * sizeof(uint32_t));
+    }
+    SDL_UnlockSurface(surface.get());
+
+    return Texture{ width, height, texels };
+}
+
+uint32_t Texture::get_width() const noexcept
+{
+    return levels_.empty() ? 0 : levels_.front().width;
+}
+
+uint32_t Texture::get_height() const noexcept
+{
+    return levels_.empty() ? 0 : levels_.front().height;
+}
+
+size_t Texture::get_num_levels() const noexcept
+{
+    return levels_.size();
+}
+
+uint32_t Texture::fetch(uint32_t x, uint32_t y, size_t level) const
+{
+    return texels_[texel_index(levels_[level], x, y)];
+}
+
+uint32_t Texture::sample(double u, double v, double lod) const
+{
+    const auto level_idx = static_cast<size_t>(std::clamp(std::floor(lod + 0.5), 0., static_cast<double>(levels_.size() - 1)));
+    const auto& level = levels_[level_idx];
+
+    const double x = (u - std::floor(u)) * level.width;
+    const double y = (1. - (v - std::floor(v))) * level.height;
+
+    return texels_[texel_index(
+        level,
+        std::min(static_cast<uint32_t>(x), level.width - 1),
+        std::min(static_cast<uint32_t>(y), level.height - 1)
+    )];
+}
+
+// Box filter every level from the previous one, odd dimensions reuse their last row or column
+void Texture::generate_mip_chain(const std::vector<uint32_t>& texels)
+{
+    const auto& base = levels_.front();
+    for (uint32_t y = 0; y < base.height; ++y)
+    {
+        for (uint32_t x = 0; x < base.width; ++x)
+        {
+            texels_[texel_index(base, x, y)] = texels[static_cast<size_t>(y) * base.width + x];
+        }
+    }
+
+    for (size_t i = 1; i < levels_.size(); ++i)
+    {
+        const auto& src = levels_[i - 1];
+        const auto& dst = levels_[i];
+
+        for (uint32_t y = 0; y < dst.height; ++y)
+        {
+            const uint32_t y0 = std::min(2 * y, src.height - 1);
+            const uint32_t y1 = std::min(2 * y + 1, src.height - 1);
+
+            for (uint32_t x = 0; x < dst.width; ++x)
+            {
+                const uint32_t x0 = std::min(2 * x, src.width - 1);
+                const uint32_t x1 = std::min(2 * x + 1, src.width - 1);
+
+                texels_[texel_index(dst, x, y)] = average_texels(
+                    texels_[texel_index(src, x0, y0)],
+                    texels_[texel_index(src, x1, y0)],
+                    texels_[texel_index(src, x0, y1)],
+                    texels_[texel_index(src, x1, y1)]
+                );
+            }
+        }
+    }
+}
+
+// Non square levels are split into square Morton blocks laid out along the longest side
+size_t Texture::texel_index(const MipLevel& level, uint32_t x, uint32_t y) const noexcept
+{
+    const uint32_t block_log2 = std::min(level.log2_padded_width, level.log2_padded_height);
+    const uint32_t block_mask = (1u << block_log2) - 1;
+    const size_t block = (x >> block_log2) + (y >> block_log2);
+
+    return level.offset + (block << (2 * block_log2)) + morton_encode(x & block_mask, y & block_mask);
+}
+
+uint32_t Texture::morton_encode(uint32_t x, uint32_t y) noexcept
+{
+    auto part_by_1 = [](uint32_t n)
+    {
+        n &= 0x0000FFFF;
+        n = (n | (n << 8)) & 0x00FF00FF;
+        n = (n | (n << 4)) & 0x0F0F0F0F;
+        n = (n | (n << 2)) & 0x33333333;
+        n = (n | (n << 1)) & 0x55555555;
+        return n;
+    };
+
+    return part_by_1(x) | (part_by_1(y) << 1);
+}
+
+}
@@ -1,6 +1,9 @@
 #include <mesh.hxx>
+#include <mesh_optimizer.hxx>
+#include <profiler.hxx>
 #include <rasterizer.hxx>
 #include <resource_handler.hxx>
+#include <texture.hxx>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
@@ -14,16 +17,21 @@
 
 #include <snowhouse/snowhouse.h>
 
+#include <charconv>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <format>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 constexpr int INITIAL_WINDOW_WIDTH = 800;
 constexpr int INITIAL_WINDOW_HEIGHT = 600;
 constexpr double PI = M_PI;
+constexpr double CAMERA_DISTANCE = 3.;
 
 namespace tinyrenderer
 {
@@ -42,6 +50,14 @@ struct WindowDimensions
     uint32_t height;
 };
 
+struct AppOptions
+{
+    std::optional<std::string> trace_path;
+    profiling::TraceLevel trace_level{ profiling::TraceLevel::Frame };
+    size_t trace_events_per_thread{ profiling::Tracer::DEFAULT_EVENTS_PER_THREAD };
+    bool optimize_mesh{};
+};
+
 class FrameInfoReporter
 {
 private:
@@ -129,13 +145,53 @@ void rotate_mesh(Mesh& mesh, double delta_time)
     });
 }
 
-void main_loop()
+// Flushing empties the buffers : on demand captures get their own numbered file,
+// or the exit flush would overwrite them with only what was recorded since
+void flush_trace(const std::optional<std::string>& trace_path, std::optional<uint32_t> capture_idx = {})
+{
+    if (!trace_path) return;
+
+    const std::string filename = capture_idx ? std::format("{}.{}.json", *trace_path, *capture_idx) : *trace_path;
+    if (profiling::Tracer::instance().flush(filename))
+    {
+        PLOG(plog::info) << "Trace written to '" << filename << "'" << std::endl;
+    }
+    else
+    {
+        PLOG(plog::error) << "Can not write trace to '" << filename << "'" << std::endl;
+    }
+}
+
+// Average time of a draw call, what ends up in the canvas is cleared by the next render anyway
+double measure_draw_time(Rasterizer& rasterizer, const Mesh& mesh)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int DRAW_COUNT = 20;
+
+    rasterizer.draw(mesh);
+
+    const auto start = Clock::now();
+    for (int i = 0; i < DRAW_COUNT; ++i)
+    {
+        rasterizer.draw(mesh);
+    }
+
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / DRAW_COUNT;
+}
+
+void main_loop(const AppOptions& options)
 {
     init_log();
     bool running = true;
 
+    if (options.trace_path)
+    {
+        profiling::Tracer::instance().enable(options.trace_level, options.trace_events_per_thread);
+    }
+
     WindowDimensions window_dimensions{ INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT };
     Mesh mesh = *Mesh::load("assets/mesh/mumbaka.obj");
+    std::optional<Texture> texture = Texture::load("assets/texture/mumbaka_diffuse.bmp");
 
     TTF_Init();
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -157,73 +213,175 @@ void main_loop()
         ) };
 
         Rasterizer rasterizer{ std::move(window) };
+        rasterizer.set_camera_distance(CAMERA_DISTANCE);
+
+        if (options.optimize_mesh)
+        {
+            auto [optimized_mesh, report] = optimize_mesh(mesh);
+            const auto draw_time_before = measure_draw_time(rasterizer, mesh);
+            const auto draw_time_after = measure_draw_time(rasterizer, optimized_mesh);
+
+            PLOG(plog::info) << std::format("Mesh optimization : {} -> {} vertices, ACMR {:.3f} -> {:.3f}",
+                report.vertices_before, report.vertices_after,
+                report.acmr_before, report.acmr_after
+            ) << std::endl;
+            PLOG(plog::info) << std::format("draw(mesh) : {:.3f}ms -> {:.3f}ms, speedup x{:.2f}",
+                draw_time_before, draw_time_after,
+                draw_time_before / draw_time_after
+            ) << std::endl;
+
+            mesh = std::move(optimized_mesh);
+        }
+
+        auto mip_selection = Rasterizer::MipSelection::PerQuad;
+        bool flush_requested = false;
+        uint32_t trace_captures = 0;
 
         while (running)
         {
-            frame_reporter.start_frame();
-            SDL_Event event;
-            while (SDL_PollEvent(&event))
+            // The frame scope has to be closed before flushing, or it would be recorded as a hitch in the new trace
             {
-                switch (event.type)
-                {
-                case SDL_WINDOWEVENT: 
+                TINYRENDERER_TRACE_SCOPE("main_loop::frame");
+
+                frame_reporter.start_frame();
                 {
-                    switch (event.window.event)
-                    {
-                    case SDL_WINDOWEVENT_RESIZED:
-                    {
-                        uint32_t width = event.window.data1;
-                        uint32_t height = event.window.data2;
+                    TINYRENDERER_TRACE_SCOPE("main_loop::poll_events");
 
-                        rasterizer.resize_canvas(width, height);
-                    }
-                    break;
-                    case SDL_WINDOWEVENT_CLOSE:
+                    SDL_Event event;
+                    while (SDL_PollEvent(&event))
                     {
-                        PLOG(plog::debug) << "Shutting down" << std::endl;
-                        running = false;
-                    } 
-                    break;
+                        switch (event.type)
+                        {
+                        case SDL_WINDOWEVENT: 
+                        {
+                            switch (event.window.event)
+                            {
+                            case SDL_WINDOWEVENT_RESIZED:
+                            {
+                                uint32_t width = event.window.data1;
+                                uint32_t height = event.window.data2;
+
+                                rasterizer.resize_canvas(width, height);
+                            }
+                            break;
+                            case SDL_WINDOWEVENT_CLOSE:
+                            {
+                                PLOG(plog::debug) << "Shutting down" << std::endl;
+                                running = false;
+                            } 
+                            break;
+                            }
+                        }
+                        break;
+                        case SDL_KEYDOWN:
+                        {
+                            switch (event.key.keysym.sym)
+                            {
+                            case SDLK_ESCAPE:
+                            case SDLK_q:
+                            {
+                                PLOG(plog::debug) << "Shutting down" << std::endl;
+                                running = false;
+                            }
+                            break;
+                            case SDLK_F9:
+                            {
+                                flush_requested = true;
+                            }
+                            break;
+                            case SDLK_m:
+                            {
+                                mip_selection = mip_selection == Rasterizer::MipSelection::PerQuad
+                                    ? Rasterizer::MipSelection::PerTriangle
+                                    : Rasterizer::MipSelection::PerQuad;
+                                rasterizer.set_mip_selection(mip_selection);
+                            }
+                            break;
+                            }
+                        }
+                        }
                     }
                 }
-                case SDL_KEYDOWN:
+
                 {
-                    switch (event.key.keysym.sym)
-                    {
-                    case SDLK_ESCAPE:
-                    case SDLK_q:
+                    TINYRENDERER_TRACE_SCOPE("main_loop::draw");
+
+                    if (texture)
                     {
-                        PLOG(plog::debug) << "Shutting down" << std::endl;
-                        running = false;
+                        rasterizer.draw(mesh, *texture);
                     }
+                    else
+                    {
+                        rasterizer.draw(mesh);
                     }
+                    rasterizer.draw_wireframe(mesh);
                 }
+                /* std::vector<Eigen::Vector2i> t0 = {{10, 70}, {50, 160}, {70, 80}};
+                std::vector<Eigen::Vector2i> t1 = { { 180, 50 }, { 150, 1 }, { 70, 180 } };
+                std::vector<Eigen::Vector2i> t2 = { { 180, 150 }, { 120, 160 }, { 130, 180 } };
+
+                rasterizer.draw_triangle(t0[0], t0[1], t0[2], { 255, 0, 0 });
+                rasterizer.draw_triangle(t1[0], t1[1], t1[2], { 255, 255, 255 });
+                rasterizer.draw_triangle(t2[0], t2[1], t2[2], { 0, 255, 0 }); */
+                rasterizer.render();
+
+                frame_reporter.end_frame();
+                {
+                    TINYRENDERER_TRACE_SCOPE("main_loop::overlay");
+
+                    rasterizer.draw_overlay(frame_reporter.get_frame_info_surface());
+                    rasterizer.render_overlay();
+                }
+                {
+                    TINYRENDERER_TRACE_SCOPE("main_loop::rotate_mesh");
+
+                    rotate_mesh(mesh, frame_reporter.get_frame_time());
                 }
             }
 
-            rasterizer.draw(mesh);
-            rasterizer.draw_wireframe(mesh);
-            /* std::vector<Eigen::Vector2i> t0 = {{10, 70}, {50, 160}, {70, 80}};
-            std::vector<Eigen::Vector2i> t1 = { { 180, 50 }, { 150, 1 }, { 70, 180 } };
-            std::vector<Eigen::Vector2i> t2 = { { 180, 150 }, { 120, 160 }, { 130, 180 } };
-
-            rasterizer.draw_triangle(t0[0], t0[1], t0[2], { 255, 0, 0 });
-            rasterizer.draw_triangle(t1[0], t1[1], t1[2], { 255, 255, 255 });
-            rasterizer.draw_triangle(t2[0], t2[1], t2[2], { 0, 255, 0 }); */
-            rasterizer.render();
-
-            frame_reporter.end_frame();
-            rasterizer.draw_overlay(frame_reporter.get_frame_info_surface());
-            rasterizer.render_overlay();
-            rotate_mesh(mesh, frame_reporter.get_frame_time());
+            if (flush_requested)
+            {
+                flush_trace(options.trace_path, ++trace_captures);
+                flush_requested = false;
+            }
         }
     }
+
+    flush_trace(options.trace_path);
 }
 
 }
 
 int main(int arc, char* argv[])
 {
-    tinyrenderer::main_loop();
+    // --trace <file> records a Chrome trace of the render loop, written on exit, pressing F9 writes <file>.<n>.json
+    // --trace-events <count> sets the size of the per thread trace ring buffers
+    // --trace-primitives also records every line and triangle drawn, which fills the buffers within seconds
+    // --optimize-mesh reorders the mesh for vertex reuse before rendering, and logs the gain
+    tinyrenderer::AppOptions options{};
+    for (int i = 1; i < arc; ++i)
+    {
+        const std::string_view arg{ argv[i] };
+
+        if (arg == "--trace" && i + 1 < arc)
+        {
+            options.trace_path = argv[++i];
+        }
+        else if (arg == "--trace-events" && i + 1 < arc)
+        {
+            const std::string_view count{ argv[++i] };
+            std::from_chars(count.data(), count.data() + count.size(), options.trace_events_per_thread);
+        }
+        else if (arg == "--trace-primitives")
+        {
+            options.trace_level = tinyrenderer::profiling::TraceLevel::Primitive;
+        }
+        else if (arg == "--optimize-mesh")
+        {
+            options.optimize_mesh = true;
+        }
+    }
+
+    tinyrenderer::main_loop(options);
     return 0;
 }
\ No newline at end of file